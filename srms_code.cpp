@@ -1,12 +1,53 @@
+#define _FILE_OFFSET_BITS 64 /* 64-bit off_t for fseeko/ftello on 32-bit POSIX */
 #include <gtk/gtk.h>
+#include <cctype>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <algorithm>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
 
 #define STUDENT_FILE "students.txt"
 #define CREDENTIAL_FILE "credentials.txt"
+#define STUDENT_TMP_FILE "students.txt.tmp"
+#define HISTORY_FILE "history.txt"
+#define HISTORY_SHOWN 4
+#define HISTORY_CHECKPOINT_ENTRIES 64 /* timestamp decode restarts from a checkpoint this often */
+#define TRENDS_LISTED 25
+
+/* Fuzzy name search: allowed typos grow by one per this many query characters */
+#define NAME_CHARS_PER_TYPO 5
+#define NAME_MATCHES_LISTED 10
+
+/* Paged record cache: rows per page and default memory budget (override with SRMS_CACHE_MB) */
+#define CACHE_PAGE_ROWS 256
+#define CACHE_DEFAULT_BUDGET_MB 64
+#define CACHE_MIN_FRAMES 4
+
+/* Parallel loader: threads are capped and small files are not split (override with SRMS_LOAD_THREADS) */
+#define LOAD_MAX_THREADS 16
+#define LOAD_MIN_CHUNK_BYTES (256 * 1024)
+#define LOAD_BATCH_ROWS 4096
+#define LOAD_IO_BUFFER (1 << 20)
+
+/* 64-bit positions in students.txt (long is 32 bits on Windows) */
+#ifdef _WIN32
+#define srms_fseek _fseeki64
+#define srms_ftell _ftelli64
+#else
+#define srms_fseek fseeko
+#define srms_ftell ftello
+#endif
 
 /* Columns for treeview */
 enum {
@@ -21,13 +62,21 @@ enum {
     N_COLUMNS
 };
 
-/* Current user and role */
+/* Current user; the role lives in the session */
 static char current_user[64] = "";
-static char current_role[32] = "";
+
+/* Roles and the capabilities they grant, resolved once at login */
+enum Role { ROLE_NONE, ROLE_ADMIN, ROLE_STAFF, ROLE_USER, ROLE_GUEST };
+
+enum {
+    CAP_VIEW_ALL = 1 << 0, /* whole roster in the main tree */
+    CAP_VIEW_SELF = 1 << 1, /* only the linked student record */
+    CAP_MODIFY = 1 << 2,   /* add, update, delete */
+    CAP_TRENDS = 1 << 3    /* grade history queries */
+};
 
 /* Structs */
 typedef struct {
-    GtkListStore *store;
     GtkTreeView *tree;
     GtkWindow *parent;
 } AppData;
@@ -40,15 +89,130 @@ struct Student {
     double cgpa[4]; // cgpa[0] = year1, cgpa[1] = year2 ...
 };
 
+struct Session {
+    Role role;
+    unsigned caps;
+    char reg_no[32];       /* student record linked to a USER login */
+    std::vector<int> rows; /* row ids visible in a filtered (VIEW_SELF) session */
+    std::vector<Student> records; /* those rows, read at login */
+};
+
+static Session current_session;
+
+/* Page replacement policy (select with SRMS_CACHE_POLICY=lru|clock) */
+enum CachePolicy { CACHE_LRU, CACHE_CLOCK };
+
+struct CachePage {
+    int page_no;             /* -1 when the frame is free */
+    bool referenced;         /* CLOCK reference bit */
+    unsigned long last_used; /* LRU tick */
+    std::vector<Student> rows;
+};
+
+/* reg_no index entry (8 bytes); sorted by hash, collisions resolved by reading the row */
+struct RegIndexEntry {
+    unsigned hash;
+    int rowid;
+};
+
+/* Record cache over students.txt. Only the line offsets of every record are
+   kept for the whole file, as a 64-bit offset per page plus a 32-bit distance
+   from it per row; the records themselves live in a bounded set of page
+   frames that the tree model reads from. Row ids stay fixed until the next
+   load: a deleted record keeps its id and is skipped from then on. */
+struct StudentCache {
+    FILE *fp;
+    std::vector<long long> page_base; /* file offset of the first record of each page */
+    std::vector<unsigned> row_delta;  /* offset of each record line from its page_base */
+    std::vector<RegIndexEntry> regno_index; /* built at load, sorted */
+    std::vector<RegIndexEntry> regno_tail;  /* records added since the last load or save */
+    std::vector<int> deleted;       /* row ids removed from the file since the load, sorted */
+    std::vector<int> page_frame;    /* page number -> frame index, -1 if not resident */
+    std::vector<CachePage> frames;
+    CachePolicy policy;
+    size_t clock_hand;
+    unsigned long tick;
+    unsigned long hits, misses, evictions;
+    int load_threads;
+    double load_ms;                 /* wall time of the last refresh, from file open to a ready model */
+    GtkWidget *status_label;
+};
+
+static StudentCache student_cache;
+
+/* Ascending row ids as varint deltas (the first one from 0) */
+struct PostingList {
+    std::vector<unsigned char> bytes;
+    int last;  /* largest row id in the list, 0 when empty */
+    int count;
+};
+
+typedef std::unordered_map<unsigned, PostingList> TrigramPostings;
+
+/* Name search index over all records: trigram postings and one length byte per row.
+   Names themselves are not kept; candidates are read back through the record cache.
+   Built by the loader and updated in place on add and update; deleted rows stay in
+   the postings and are skipped when candidates are verified */
+struct NameIndex {
+    std::vector<unsigned char> lengths; /* name lengths by row id, for the length filter */
+    TrigramPostings postings;
+    std::vector<unsigned char> counts;  /* per-row query scratch, kept zeroed between queries */
+};
+
+static NameIndex name_index;
+
+/* One decoded grade history entry */
+struct HistoryEntry {
+    int semester;
+    long long timestamp;
+    bool has_sgpa; /* false when no SGPA was entered for the update */
+    double sgpa;
+    bool has_cgpa; /* false when no CGPA was entered; cgpa then repeats the previous one */
+    double cgpa;
+};
+
+/* Per-semester grade history, appended to history.txt and held in memory as
+   columns. Timestamps are zigzag varint deltas from the previous entry and
+   grades are centi-point deltas from the same student's previous entry. The
+   per-student columns keep the CGPA of the last two semesters (a second entry
+   for the same semester is a correction and replaces the first) so trend
+   queries scan two short arrays instead of the log. Each series also lists
+   its entry indices, and a checkpoint of the running timestamp is kept every
+   HISTORY_CHECKPOINT_ENTRIES entries, so one student's history decodes
+   without walking the whole timestamp column. */
+struct GradeHistory {
+    bool loaded;
+    /* entry columns, in append order */
+    std::vector<int> series;
+    std::vector<unsigned char> semester;
+    std::vector<unsigned char> ts_delta;
+    std::vector<short> sgpa_delta, cgpa_delta;   /* deltas are 0 for entries without that grade */
+    std::vector<bool> sgpa_present, cgpa_present; /* bitmaps: entry has an SGPA / a CGPA */
+    long long last_ts;
+    std::vector<size_t> ckpt_pos;     /* ts_delta offset of entry k * HISTORY_CHECKPOINT_ENTRIES */
+    std::vector<long long> ckpt_ts;   /* timestamp just before that entry */
+    /* per-student columns, indexed by series id */
+    std::unordered_map<std::string, int> series_of;
+    std::vector<std::string> reg_nos;
+    std::vector<unsigned char> last_sem, prev_sem; /* prev_sem is 0 until a second semester is seen */
+    std::vector<short> last_sgpa, last_cgpa, prev_cgpa;
+    std::vector<std::vector<int> > entries; /* entry indices of each series, ascending */
+};
+
+static GradeHistory grade_history;
+
 /* Forward declarations */
 static void show_login_dialog(GtkWindow *parent);
 static void show_main_window(GtkWindow *parent);
-static void show_add_student_dialog(GtkWindow *parent, GtkListStore *store);
-static void show_update_student_dialog(GtkWindow *parent, GtkListStore *store, Student student, GtkTreeIter iter);
-static void show_search_by_regno_dialog(GtkWindow *parent, GtkListStore *store);
-static void refresh_tree_store(GtkListStore *store);
-static void save_store_to_file(GtkListStore *store);
-static gboolean load_credentials(const char *username, const char *password, char *out_role, size_t role_len);
+static void show_add_student_dialog(GtkWindow *parent, GtkTreeView *tree);
+static void show_update_student_dialog(GtkWindow *parent, GtkTreeView *tree, Student student, GtkTreeIter iter);
+static void show_search_by_regno_dialog(GtkWindow *parent, GtkTreeView *tree);
+static void show_search_by_name_dialog(GtkWindow *parent, GtkTreeView *tree);
+static void show_cgpa_trends_dialog(GtkWindow *parent);
+static void refresh_tree_store(GtkTreeView *tree);
+static bool cache_peek(int rowid, Student *out);
+static void history_load();
+static gboolean load_credentials(const char *username, const char *password, char *out_role, size_t role_len, char *out_regno, size_t regno_len);
 static void show_message(GtkWindow *parent, const char *title, const char *message);
 static void delete_selected_student(GtkWindow *parent, GtkTreeView *treeview);
 
@@ -61,7 +225,7 @@ static void ensure_default_credentials_and_files() {
         if (cf) {
             fprintf(cf, "admin admin123 ADMIN\n");
             fprintf(cf, "staff staff123 STAFF\n");
-            fprintf(cf, "student 123456 USER\n");
+            fprintf(cf, "student 123456 USER AP24110010714\n");
             fprintf(cf, "guest guest GUEST\n");
             fclose(cf);
         }
@@ -72,15 +236,20 @@ static void ensure_default_credentials_and_files() {
     if (sf) fclose(sf);
 }
 
-/* Read credentials file and match */
-static gboolean load_credentials(const char *username, const char *password, char *out_role, size_t role_len) {
+/* Read credentials file and match; lines are "user password ROLE [reg_no]" and
+   the optional reg_no links a USER login to a student record (defaults to the username) */
+static gboolean load_credentials(const char *username, const char *password, char *out_role, size_t role_len, char *out_regno, size_t regno_len) {
     FILE *fp = fopen(CREDENTIAL_FILE, "r");
     if (!fp) return FALSE;
-    char u[128], p[128], r[64];
-    while (fscanf(fp, "%127s %127s %63s", u, p, r) == 3) {
+    char line[512], u[128], p[128], r[64], reg[32];
+    while (fgets(line, sizeof(line), fp)) {
+        int n = sscanf(line, "%127s %127s %63s %31s", u, p, r, reg);
+        if (n < 3) continue;
         if (strcmp(u, username) == 0 && strcmp(p, password) == 0) {
             strncpy(out_role, r, role_len - 1);
             out_role[role_len - 1] = '\0';
+            strncpy(out_regno, n == 4 ? reg : u, regno_len - 1);
+            out_regno[regno_len - 1] = '\0';
             fclose(fp);
             return TRUE;
         }
@@ -89,6 +258,44 @@ static gboolean load_credentials(const char *username, const char *password, cha
     return FALSE;
 }
 
+/* Resolve the role string into the session's role and capability mask */
+static void session_begin(const char *role, const char *reg_no) {
+    current_session.rows.clear();
+    current_session.records.clear();
+    strncpy(current_session.reg_no, reg_no, sizeof(current_session.reg_no) - 1);
+    current_session.reg_no[sizeof(current_session.reg_no) - 1] = '\0';
+    if (strcmp(role, "ADMIN") == 0) {
+        current_session.role = ROLE_ADMIN;
+        current_session.caps = CAP_VIEW_ALL | CAP_MODIFY | CAP_TRENDS;
+    } else if (strcmp(role, "STAFF") == 0) {
+        current_session.role = ROLE_STAFF;
+        current_session.caps = CAP_VIEW_ALL | CAP_MODIFY | CAP_TRENDS;
+    } else if (strcmp(role, "GUEST") == 0) {
+        current_session.role = ROLE_GUEST;
+        current_session.caps = CAP_VIEW_ALL;
+    } else if (strcmp(role, "USER") == 0) {
+        current_session.role = ROLE_USER;
+        current_session.caps = CAP_VIEW_SELF;
+    } else {
+        current_session.role = ROLE_NONE;
+        current_session.caps = 0;
+    }
+}
+
+static bool session_can(unsigned cap) {
+    return (current_session.caps & cap) != 0;
+}
+
+static const char *role_name(Role role) {
+    switch (role) {
+    case ROLE_ADMIN: return "ADMIN";
+    case ROLE_STAFF: return "STAFF";
+    case ROLE_USER: return "USER";
+    case ROLE_GUEST: return "GUEST";
+    default: return "NONE";
+    }
+}
+
 /* Show a simple message dialog */
 static void show_message(GtkWindow *parent, const char *title, const char *message) {
     GtkWidget *dlg = gtk_message_dialog_new(parent,
@@ -100,68 +307,1219 @@ static void show_message(GtkWindow *parent, const char *title, const char *messa
     gtk_widget_destroy(dlg);
 }
 
-/* Load students.txt into liststore */
-static void refresh_tree_store(GtkListStore *store) {
-    gtk_list_store_clear(store);
-    FILE *fp = fopen(STUDENT_FILE, "r");
+/* students.txt is space-separated, so a field must not contain whitespace */
+static bool has_whitespace(const char *s) {
+    for (; *s; s++) if (isspace((unsigned char)*s)) return true;
+    return false;
+}
+
+/* Parse one students.txt line; missing CGPA fields default to 0 */
+static bool parse_student_line(const char *line, Student *s) {
+    s->cgpa[0] = s->cgpa[1] = s->cgpa[2] = s->cgpa[3] = 0.0;
+    return sscanf(line, "%31s %127s %d %d %lf %lf %lf %lf",
+                  s->reg_no, s->name, &s->year, &s->semester,
+                  &s->cgpa[0], &s->cgpa[1], &s->cgpa[2], &s->cgpa[3]) >= 4;
+}
+
+/* Size the frame pool from the memory budget and pick the eviction policy */
+static void cache_configure() {
+    const char *mb = getenv("SRMS_CACHE_MB");
+    long budget_mb = (mb && atol(mb) > 0) ? atol(mb) : CACHE_DEFAULT_BUDGET_MB;
+    size_t page_bytes = CACHE_PAGE_ROWS * sizeof(Student);
+    size_t n_frames = (size_t)budget_mb * 1024 * 1024 / page_bytes;
+    if (n_frames < CACHE_MIN_FRAMES) n_frames = CACHE_MIN_FRAMES;
+
+    const char *pol = getenv("SRMS_CACHE_POLICY");
+    student_cache.policy = (pol && strcmp(pol, "clock") == 0) ? CACHE_CLOCK : CACHE_LRU;
+
+    student_cache.frames.assign(n_frames, CachePage());
+    for (size_t i = 0; i < n_frames; i++) student_cache.frames[i].page_no = -1;
+    student_cache.clock_hand = 0;
+}
+
+/* Drop all resident pages and close the backing file */
+static void cache_reset() {
+    if (student_cache.fp) { fclose(student_cache.fp); student_cache.fp = NULL; }
+    for (size_t i = 0; i < student_cache.frames.size(); i++) {
+        student_cache.frames[i].page_no = -1;
+        std::vector<Student>().swap(student_cache.frames[i].rows);
+    }
+    student_cache.page_frame.clear();
+}
+
+static int cache_row_count() {
+    return (int)student_cache.row_delta.size();
+}
+
+/* File offset of a record line */
+static long long cache_row_offset(int rowid) {
+    return student_cache.page_base[rowid / CACHE_PAGE_ROWS] + student_cache.row_delta[rowid];
+}
+
+/* Append the offset of the next row id (rows of one page lie within 4 GB of its first row) */
+static void cache_push_offset(long long offset) {
+    if (student_cache.row_delta.size() % CACHE_PAGE_ROWS == 0) student_cache.page_base.push_back(offset);
+    student_cache.row_delta.push_back((unsigned)(offset - student_cache.page_base.back()));
+}
+
+static bool cache_is_deleted(int rowid) {
+    return std::binary_search(student_cache.deleted.begin(), student_cache.deleted.end(), rowid);
+}
+
+/* Records still in the file, i.e. rows shown in the tree */
+static int cache_visible_count() {
+    return cache_row_count() - (int)student_cache.deleted.size();
+}
+
+/* Tree position of a live row id */
+static int cache_pos_of(int rowid) {
+    return rowid - (int)(std::lower_bound(student_cache.deleted.begin(), student_cache.deleted.end(), rowid) - student_cache.deleted.begin());
+}
+
+/* Row id at a tree position: the smallest r with r - (deleted ids <= r) == pos */
+static int cache_rowid_at(int pos) {
+    int r = pos;
+    for (;;) {
+        int next = pos + (int)(std::upper_bound(student_cache.deleted.begin(), student_cache.deleted.end(), r) - student_cache.deleted.begin());
+        if (next == r) return r;
+        r = next;
+    }
+}
+
+/* 64-bit FNV-1a hash of a registration number, folded to 32 bits for the reg_no index */
+static unsigned regno_hash(const char *reg) {
+    unsigned long long h = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char *)reg; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    return (unsigned)(h ^ (h >> 32));
+}
+
+static bool regno_entry_less(const RegIndexEntry &a, const RegIndexEntry &b) {
+    return a.hash < b.hash || (a.hash == b.hash && a.rowid < b.rowid);
+}
+
+/* Fuzzy name search: names are lower-cased and padded as "  name " before taking trigrams */
+static int name_normalize(const char *name, char *out, int cap) {
+    int n = 0;
+    for (; name[n] && n < cap - 1; n++) out[n] = (char)tolower((unsigned char)name[n]);
+    out[n] = '\0';
+    return n;
+}
+
+/* Distinct trigrams of a name, sorted */
+static void name_trigrams(const char *name, std::vector<unsigned> &out) {
+    char buf[sizeof(((Student *)0)->name) + 3];
+    buf[0] = buf[1] = ' ';
+    int n = name_normalize(name, buf + 2, sizeof(buf) - 3);
+    buf[n + 2] = ' ';
+    out.clear();
+    for (int i = 0; i < n + 1; i++) {
+        out.push_back(((unsigned)(unsigned char)buf[i] << 16) | ((unsigned)(unsigned char)buf[i + 1] << 8) | (unsigned char)buf[i + 2]);
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+static void put_uvarint(std::vector<unsigned char> &out, unsigned v) {
+    while (v >= 0x80) { out.push_back((unsigned char)(v | 0x80)); v >>= 7; }
+    out.push_back((unsigned char)v);
+}
+
+static unsigned get_uvarint(const unsigned char *p, size_t *pos) {
+    unsigned v = 0;
+    for (int shift = 0;; shift += 7) {
+        unsigned char b = p[(*pos)++];
+        v |= (unsigned)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+    }
+}
+
+/* Add a row id to a posting list. Appends are O(1); an id inside the list replaces
+   the delta of its successor with two deltas, leaving the rest of the bytes as they are */
+static void posting_insert(PostingList &pl, int rowid) {
+    if (pl.count == 0 || rowid > pl.last) {
+        put_uvarint(pl.bytes, (unsigned)(rowid - pl.last));
+        pl.last = rowid;
+        pl.count++;
+        return;
+    }
+    size_t pos = 0;
+    int prev = 0;
+    while (pos < pl.bytes.size()) {
+        size_t at = pos;
+        int v = prev + (int)get_uvarint(pl.bytes.data(), &pos);
+        if (v == rowid) return;
+        if (v > rowid) {
+            std::vector<unsigned char> mid;
+            put_uvarint(mid, (unsigned)(rowid - prev));
+            put_uvarint(mid, (unsigned)(v - rowid));
+            pl.bytes.erase(pl.bytes.begin() + at, pl.bytes.begin() + pos);
+            pl.bytes.insert(pl.bytes.begin() + at, mid.begin(), mid.end());
+            pl.count++;
+            return;
+        }
+        prev = v;
+    }
+}
+
+/* Remove a row id from a posting list; its successor's delta absorbs the gap */
+static void posting_remove(PostingList &pl, int rowid) {
+    size_t pos = 0;
+    int prev = 0;
+    while (pos < pl.bytes.size()) {
+        size_t at = pos;
+        int v = prev + (int)get_uvarint(pl.bytes.data(), &pos);
+        if (v > rowid) return;
+        if (v == rowid) {
+            if (pos == pl.bytes.size()) {
+                pl.bytes.erase(pl.bytes.begin() + at, pl.bytes.end());
+                pl.last = prev;
+            } else {
+                int next = v + (int)get_uvarint(pl.bytes.data(), &pos);
+                std::vector<unsigned char> gap;
+                put_uvarint(gap, (unsigned)(next - prev));
+                pl.bytes.erase(pl.bytes.begin() + at, pl.bytes.begin() + pos);
+                pl.bytes.insert(pl.bytes.begin() + at, gap.begin(), gap.end());
+            }
+            pl.count--;
+            return;
+        }
+        prev = v;
+    }
+}
+
+/* Add a row to trigram postings */
+static void postings_add(TrigramPostings &postings, const char *name, int rowid, std::vector<unsigned> &scratch) {
+    name_trigrams(name, scratch);
+    for (size_t i = 0; i < scratch.size(); i++) posting_insert(postings[scratch[i]], rowid);
+}
+
+static void name_index_clear() {
+    std::vector<unsigned char>().swap(name_index.lengths);
+    TrigramPostings().swap(name_index.postings);
+    std::vector<unsigned char>().swap(name_index.counts);
+}
+
+static unsigned char name_length_byte(const char *name) {
+    return (unsigned char)std::min(strlen(name), (size_t)255);
+}
+
+/* Index a record appended with the given row id */
+static void name_index_add(int rowid, const char *name) {
+    if ((int)name_index.lengths.size() <= rowid) name_index.lengths.resize(rowid + 1);
+    name_index.lengths[rowid] = name_length_byte(name);
+    std::vector<unsigned> scratch;
+    postings_add(name_index.postings, name, rowid, scratch);
+}
+
+/* Re-index a renamed record: only the trigrams that differ between the names are touched */
+static void name_index_update(int rowid, const char *old_name, const char *new_name) {
+    if (rowid < 0 || rowid >= (int)name_index.lengths.size()) return;
+    name_index.lengths[rowid] = name_length_byte(new_name);
+    std::vector<unsigned> before, after;
+    name_trigrams(old_name, before);
+    name_trigrams(new_name, after);
+    for (size_t i = 0; i < before.size(); i++) {
+        if (std::binary_search(after.begin(), after.end(), before[i])) continue;
+        TrigramPostings::iterator it = name_index.postings.find(before[i]);
+        if (it == name_index.postings.end()) continue;
+        posting_remove(it->second, rowid);
+        if (it->second.count == 0) name_index.postings.erase(it);
+    }
+    for (size_t i = 0; i < after.size(); i++) {
+        if (!std::binary_search(before.begin(), before.end(), after[i])) posting_insert(name_index.postings[after[i]], rowid);
+    }
+}
+
+/* Query pattern for the bit-parallel edit distance: one match mask per byte value */
+struct NamePattern {
+    unsigned long long peq[256];
+    const char *text;
+    int len;
+};
+
+static void name_pattern_init(NamePattern *p, const char *q, int m) {
+    memset(p->peq, 0, sizeof(p->peq));
+    p->text = q;
+    p->len = m;
+    for (int i = 0; i < m && i < 64; i++) p->peq[(unsigned char)q[i]] |= 1ULL << i;
+}
+
+/* Plain two-row Levenshtein distance, used for patterns longer than 64 characters */
+static int name_distance_dp(const char *a, int m, const char *b, int n) {
+    std::vector<int> prev(n + 1), cur(n + 1);
+    for (int j = 0; j <= n; j++) prev[j] = j;
+    for (int i = 1; i <= m; i++) {
+        cur[0] = i;
+        for (int j = 1; j <= n; j++) {
+            int sub = prev[j - 1] + (a[i - 1] != b[j - 1]);
+            int del = prev[j] + 1, ins = cur[j - 1] + 1;
+            cur[j] = std::min(sub, std::min(del, ins));
+        }
+        prev.swap(cur);
+    }
+    return prev[n];
+}
+
+/* Levenshtein distance with Myers' bit-vector algorithm (Hyyro's edit distance form):
+   a whole DP column lives in one 64-bit word, so each text character costs a few
+   word operations instead of one update per pattern character */
+static int name_distance(const NamePattern *p, const char *t, int n) {
+    int m = p->len;
+    if (m == 0) return n;
+    if (m > 64) return name_distance_dp(p->text, m, t, n);
+    unsigned long long pv = (m == 64) ? ~0ULL : ((1ULL << m) - 1);
+    unsigned long long mv = 0;
+    unsigned long long last = 1ULL << (m - 1);
+    int score = m;
+    for (int j = 0; j < n; j++) {
+        unsigned long long eq = p->peq[(unsigned char)t[j]];
+        unsigned long long xv = eq | mv;
+        unsigned long long xh = (((eq & pv) + pv) ^ pv) | eq;
+        unsigned long long ph = mv | ~(xh | pv);
+        unsigned long long mh = pv & xh;
+        if (ph & last) score++;
+        else if (mh & last) score--;
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score;
+}
+
+struct NameMatch {
+    int rowid;
+    int distance;
+    int shared; /* trigrams shared with the query */
+};
+
+static bool name_match_less(const NameMatch &a, const NameMatch &b) {
+    if (a.distance != b.distance) return a.distance < b.distance;
+    if (a.shared != b.shared) return a.shared > b.shared;
+    return a.rowid < b.rowid;
+}
+
+/* All rows within `max_typos` edits of the normalized query `q`. Candidates must share
+   enough trigrams with the query (each edit breaks at most three) before the distance
+   kernel runs on them */
+static std::vector<NameMatch> name_index_candidates(const char *q, int m, const std::vector<unsigned> &grams, int max_typos) {
+    std::vector<NameMatch> out;
+    int min_shared = (int)grams.size() - 3 * max_typos;
+    if (min_shared < 1) min_shared = 1;
+
+    /* rarest trigrams first; a row missing all of the first (G - min_shared + 1)
+       cannot reach min_shared, so only those lists seed candidates */
+    std::vector<const PostingList *> lists;
+    for (size_t g = 0; g < grams.size(); g++) {
+        TrigramPostings::const_iterator it = name_index.postings.find(grams[g]);
+        if (it != name_index.postings.end()) lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const PostingList *a, const PostingList *b) { return a->count < b->count; });
+    size_t seed_lists = grams.size() - min_shared + 1;
+    if (seed_lists > lists.size()) seed_lists = lists.size();
+
+    /* count shared trigrams per row, remembering which counters were touched */
+    std::vector<unsigned char> &counts = name_index.counts;
+    if (counts.size() < name_index.lengths.size()) counts.resize(name_index.lengths.size(), 0);
+    std::vector<int> touched;
+    for (size_t l = 0; l < seed_lists; l++) {
+        const unsigned char *p = lists[l]->bytes.data();
+        size_t pos = 0;
+        int r = 0;
+        for (int k = 0; k < lists[l]->count; k++) {
+            r += (int)get_uvarint(p, &pos);
+            if (abs((int)name_index.lengths[r] - m) > max_typos) continue;
+            if (counts[r]++ == 0) touched.push_back(r);
+        }
+    }
+    /* the remaining lists only add to rows that are already candidates */
+    for (size_t l = seed_lists; l < lists.size(); l++) {
+        const unsigned char *p = lists[l]->bytes.data();
+        size_t pos = 0;
+        int r = 0;
+        for (int k = 0; k < lists[l]->count; k++) {
+            r += (int)get_uvarint(p, &pos);
+            if (counts[r]) counts[r]++;
+        }
+    }
+
+    /* verify against the records themselves, in row order so the file is read forward */
+    std::vector<NameMatch> cands;
+    for (size_t k = 0; k < touched.size(); k++) {
+        int r = touched[k];
+        int shared = counts[r];
+        counts[r] = 0;
+        if (shared >= min_shared && !cache_is_deleted(r)) {
+            NameMatch nm = { r, 0, shared };
+            cands.push_back(nm);
+        }
+    }
+    std::sort(cands.begin(), cands.end(), [](const NameMatch &a, const NameMatch &b) { return a.rowid < b.rowid; });
+    NamePattern pat;
+    name_pattern_init(&pat, q, m);
+    char cand[sizeof(((Student *)0)->name)];
+    Student s;
+    for (size_t k = 0; k < cands.size(); k++) {
+        if (!cache_peek(cands[k].rowid, &s)) continue;
+        int n = name_normalize(s.name, cand, sizeof(cand));
+        cands[k].distance = name_distance(&pat, cand, n);
+        if (cands[k].distance <= max_typos) out.push_back(cands[k]);
+    }
+    return out;
+}
+
+/* Best `top_k` matches by edit distance. The typo budget is widened one edit at a time
+   and stops once enough matches are found, since later passes only add worse ones */
+static std::vector<NameMatch> name_index_search(const char *query, size_t top_k) {
+    std::vector<NameMatch> out;
+    char q[sizeof(((Student *)0)->name)];
+    int m = name_normalize(query, q, sizeof(q));
+    if (m == 0) return out;
+    std::vector<unsigned> grams;
+    name_trigrams(q, grams);
+    int max_typos = m / NAME_CHARS_PER_TYPO + 1;
+    for (int k = 1; k <= max_typos; k++) {
+        out = name_index_candidates(q, m, grams, k);
+        if (out.size() >= top_k) break;
+    }
+    if (out.size() > top_k) {
+        std::partial_sort(out.begin(), out.begin() + top_k, out.end(), name_match_less);
+        out.resize(top_k);
+    } else {
+        std::sort(out.begin(), out.end(), name_match_less);
+    }
+    return out;
+}
+
+/* Byte range of students.txt handled by one loader thread */
+struct LoadChunk {
+    long long begin, end;
+    std::vector<long long> offsets;   /* offsets of the records in this chunk */
+    std::vector<RegIndexEntry> index; /* sorted; rowid is local to the chunk until merged */
+    std::vector<unsigned char> lengths; /* name lengths by local rowid */
+    TrigramPostings grams;            /* partial name index, local rowids */
+    bool ok;                          /* the whole byte range was read */
+};
+
+/* Loader worker: read and parse the chunk in batches, then hash each batch into the partial index */
+static void load_chunk_worker(LoadChunk *chunk) {
+    chunk->ok = false;
+    FILE *fp = fopen(STUDENT_FILE, "rb");
     if (!fp) return;
-    char reg[32], name[128];
-    int year = 0, sem = 0;
-    double cg1 = 0.0, cg2 = 0.0, cg3 = 0.0, cg4 = 0.0;
-    while (fscanf(fp, "%31s %127s %d %d %lf %lf %lf %lf",
-                  reg, name, &year, &sem, &cg1, &cg2, &cg3, &cg4) >= 4) {
-        GtkTreeIter iter;
-        gtk_list_store_append(store, &iter);
-        gtk_list_store_set(store, &iter,
-                           COL_REGNO, reg,
-                           COL_NAME, name,
-                           COL_YEAR, year,
-                           COL_SEM, sem,
-                           COL_CGPA1, cg1,
-                           COL_CGPA2, cg2,
-                           COL_CGPA3, cg3,
-                           COL_CGPA4, cg4,
-                           -1);
+    setvbuf(fp, NULL, _IOFBF, LOAD_IO_BUFFER);
+    if (srms_fseek(fp, chunk->begin, SEEK_SET) != 0) { fclose(fp); return; }
+    std::vector<Student> batch;
+    batch.reserve(LOAD_BATCH_ROWS);
+    std::vector<unsigned> scratch;
+    char line[512];
+    long long off = chunk->begin;
+    bool more = true;
+    while (more) {
+        batch.clear();
+        while (batch.size() < LOAD_BATCH_ROWS) {
+            if (off >= chunk->end || !fgets(line, sizeof(line), fp)) { more = false; break; }
+            Student s;
+            if (parse_student_line(line, &s)) {
+                chunk->offsets.push_back(off);
+                batch.push_back(s);
+            }
+            off += (long long)strlen(line);
+        }
+        int base = (int)(chunk->offsets.size() - batch.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            RegIndexEntry e = { regno_hash(batch[i].reg_no), base + (int)i };
+            chunk->index.push_back(e);
+            chunk->lengths.push_back(name_length_byte(batch[i].name));
+            postings_add(chunk->grams, batch[i].name, base + (int)i, scratch);
+        }
     }
+    chunk->ok = off >= chunk->end && !ferror(fp);
     fclose(fp);
+    std::sort(chunk->index.begin(), chunk->index.end(), regno_entry_less);
+}
+
+/* Merged postings of one trigram, with its key for looking up the per-chunk lists */
+struct PostingSlot {
+    unsigned gram;
+    PostingList *list;
+};
+
+/* Loader merge worker: for every `stride`-th trigram from `first`, append each chunk's
+   list in file order. Chunk lists are copied as they are; only their first delta is
+   re-encoded against the merged list, after rebasing it by the chunk's first row id */
+static void merge_postings_worker(std::vector<PostingSlot> *slots, size_t first, size_t stride,
+                                  const std::vector<LoadChunk> *chunks, const std::vector<int> *bases) {
+    for (size_t k = first; k < slots->size(); k += stride) {
+        PostingList &dst = *(*slots)[k].list;
+        for (size_t c = 0; c < chunks->size(); c++) {
+            TrigramPostings::const_iterator it = (*chunks)[c].grams.find((*slots)[k].gram);
+            if (it == (*chunks)[c].grams.end()) continue;
+            const PostingList &src = it->second;
+            size_t pos = 0;
+            int head = (int)get_uvarint(src.bytes.data(), &pos) + (*bases)[c];
+            put_uvarint(dst.bytes, (unsigned)(head - dst.last));
+            dst.bytes.insert(dst.bytes.end(), src.bytes.begin() + pos, src.bytes.end());
+            dst.last = src.last + (*bases)[c];
+            dst.count += src.count;
+        }
+    }
+}
+
+/* Number of loader threads for a file of the given size (override with SRMS_LOAD_THREADS) */
+static int load_thread_count(long long size) {
+    const char *env = getenv("SRMS_LOAD_THREADS");
+    int n = (env && atoi(env) > 0) ? atoi(env) : (int)std::thread::hardware_concurrency();
+    if (n < 1) n = 1;
+    if (n > LOAD_MAX_THREADS) n = LOAD_MAX_THREADS;
+    long long by_size = size / LOAD_MIN_CHUNK_BYTES;
+    if (by_size < 1) by_size = 1;
+    if (n > by_size) n = (int)by_size;
+    return n;
+}
+
+/* Open students.txt and build the record offsets and reg_no index with a pool of loader threads;
+   one more thread parses history.txt meanwhile, so the update dialog does not. A chunk whose worker could not read it is retried on this thread; if that fails too the
+   cache is left empty and false is returned. A missing file is an empty roster. */
+static bool cache_build_index() {
+    cache_reset();
+    if (student_cache.frames.empty()) cache_configure();
+    student_cache.page_base.clear();
+    student_cache.row_delta.clear();
+    student_cache.regno_index.clear();
+    student_cache.regno_tail.clear();
+    student_cache.deleted.clear();
+    name_index_clear();
+    student_cache.fp = fopen(STUDENT_FILE, "rb");
+    if (!student_cache.fp) return true;
+    srms_fseek(student_cache.fp, 0, SEEK_END);
+    long long size = srms_ftell(student_cache.fp);
+
+    /* split at line boundaries: each chunk after the first starts just past a newline */
+    int n = load_thread_count(size);
+    std::vector<LoadChunk> chunks(n);
+    for (int i = 0; i < n; i++) {
+        long long pos = (long long)((double)size * i / n);
+        if (i > 0) {
+            srms_fseek(student_cache.fp, pos - 1, SEEK_SET);
+            int c;
+            while ((c = fgetc(student_cache.fp)) != EOF && c != '\n') pos++;
+            if (pos > size) pos = size;
+        }
+        chunks[i].begin = pos;
+        if (i > 0) chunks[i - 1].end = pos;
+    }
+    chunks[n - 1].end = size;
+
+    std::vector<std::thread> workers;
+    workers.push_back(std::thread(history_load));
+    for (int i = 1; i < n; i++) workers.push_back(std::thread(load_chunk_worker, &chunks[i]));
+    load_chunk_worker(&chunks[0]);
+    for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+    for (int i = 0; i < n; i++) {
+        if (chunks[i].ok) continue;
+        LoadChunk retry;
+        retry.begin = chunks[i].begin;
+        retry.end = chunks[i].end;
+        load_chunk_worker(&retry);
+        if (!retry.ok) {
+            fclose(student_cache.fp);
+            student_cache.fp = NULL;
+            return false;
+        }
+        std::swap(chunks[i], retry);
+    }
+
+    /* merge in file order: concatenate offsets, rebase row ids and merge the sorted partial indexes */
+    size_t total = 0;
+    for (int i = 0; i < n; i++) total += chunks[i].offsets.size();
+    student_cache.page_base.reserve((total + CACHE_PAGE_ROWS - 1) / CACHE_PAGE_ROWS);
+    student_cache.row_delta.reserve(total);
+    student_cache.regno_index.reserve(total);
+    name_index.lengths.reserve(total);
+    std::vector<int> bases(n);
+    for (int i = 0; i < n; i++) {
+        int base = cache_row_count();
+        bases[i] = base;
+        for (size_t j = 0; j < chunks[i].offsets.size(); j++) cache_push_offset(chunks[i].offsets[j]);
+        size_t mid = student_cache.regno_index.size();
+        for (size_t j = 0; j < chunks[i].index.size(); j++) {
+            RegIndexEntry e = chunks[i].index[j];
+            e.rowid += base;
+            student_cache.regno_index.push_back(e);
+        }
+        name_index.lengths.insert(name_index.lengths.end(), chunks[i].lengths.begin(), chunks[i].lengths.end());
+        std::vector<long long>().swap(chunks[i].offsets);
+        std::vector<RegIndexEntry>().swap(chunks[i].index);
+        std::vector<unsigned char>().swap(chunks[i].lengths);
+        std::inplace_merge(student_cache.regno_index.begin(), student_cache.regno_index.begin() + mid,
+                           student_cache.regno_index.end(), regno_entry_less);
+    }
+
+    /* name postings: create every trigram's merged list here, then the loader threads
+       fill disjoint lists from the per-chunk postings */
+    for (int i = 0; i < n; i++) {
+        for (TrigramPostings::const_iterator g = chunks[i].grams.begin(); g != chunks[i].grams.end(); ++g)
+            name_index.postings[g->first];
+    }
+    std::vector<PostingSlot> slots;
+    slots.reserve(name_index.postings.size());
+    for (TrigramPostings::iterator g = name_index.postings.begin(); g != name_index.postings.end(); ++g) {
+        PostingSlot slot = { g->first, &g->second };
+        slots.push_back(slot);
+    }
+    workers.clear();
+    for (int i = 1; i < n; i++) workers.push_back(std::thread(merge_postings_worker, &slots, (size_t)i, (size_t)n, &chunks, &bases));
+    merge_postings_worker(&slots, 0, n, &chunks, &bases);
+    for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+    for (int i = 0; i < n; i++) TrigramPostings().swap(chunks[i].grams);
+    student_cache.page_frame.assign((cache_row_count() + CACHE_PAGE_ROWS - 1) / CACHE_PAGE_ROWS, -1);
+    student_cache.load_threads = n;
+    return true;
+}
+
+/* Read a single record straight from the file, bypassing the frame pool */
+static bool cache_read_row_direct(int rowid, Student *out) {
+    if (!student_cache.fp || rowid < 0 || rowid >= cache_row_count() || cache_is_deleted(rowid)) return false;
+    char line[512];
+    if (srms_fseek(student_cache.fp, cache_row_offset(rowid), SEEK_SET) != 0) return false;
+    if (!fgets(line, sizeof(line), student_cache.fp)) return false;
+    return parse_student_line(line, out);
+}
+
+/* Choose a frame for a new page, evicting its current page if needed */
+static size_t cache_pick_frame() {
+    std::vector<CachePage> &frames = student_cache.frames;
+    size_t victim = 0;
+    bool found_free = false;
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (frames[i].page_no < 0) { victim = i; found_free = true; break; }
+    }
+    if (!found_free) {
+        if (student_cache.policy == CACHE_CLOCK) {
+            while (frames[student_cache.clock_hand].referenced) {
+                frames[student_cache.clock_hand].referenced = false;
+                student_cache.clock_hand = (student_cache.clock_hand + 1) % frames.size();
+            }
+            victim = student_cache.clock_hand;
+            student_cache.clock_hand = (student_cache.clock_hand + 1) % frames.size();
+        } else {
+            for (size_t i = 1; i < frames.size(); i++) {
+                if (frames[i].last_used < frames[victim].last_used) victim = i;
+            }
+        }
+        student_cache.page_frame[frames[victim].page_no] = -1;
+        student_cache.evictions++;
+    }
+    return victim;
+}
+
+/* Return the resident page holding a row, loading it on a miss. Each live row
+   reads exactly the line at its own offset (seeking only when the previous
+   read did not end there); deleted rows and lines that fail to parse get an
+   empty slot, so slots stay row-aligned */
+static CachePage *cache_get_page(int page_no) {
+    int f = student_cache.page_frame[page_no];
+    if (f >= 0) {
+        student_cache.hits++;
+    } else {
+        student_cache.misses++;
+        f = (int)cache_pick_frame();
+        CachePage &pg = student_cache.frames[f];
+        pg.rows.clear();
+        int first = page_no * CACHE_PAGE_ROWS;
+        int last = first + CACHE_PAGE_ROWS;
+        if (last > cache_row_count()) last = cache_row_count();
+        pg.rows.reserve(last - first);
+        char line[512];
+        long long pos = -1; /* file position after the last read, -1 when unknown */
+        for (int r = first; r < last; r++) {
+            Student s = Student();
+            if (!cache_is_deleted(r)) {
+                long long at = cache_row_offset(r);
+                if (pos != at) srms_fseek(student_cache.fp, at, SEEK_SET);
+                if (fgets(line, sizeof(line), student_cache.fp)) {
+                    pos = at + (long long)strlen(line);
+                    if (!parse_student_line(line, &s)) s = Student();
+                } else {
+                    pos = -1;
+                }
+            }
+            pg.rows.push_back(s);
+        }
+        pg.page_no = page_no;
+        student_cache.page_frame[page_no] = f;
+    }
+    CachePage *pg = &student_cache.frames[f];
+    pg->referenced = true;
+    pg->last_used = ++student_cache.tick;
+    return pg;
+}
+
+/* Fetch one record through the cache */
+static bool cache_fetch(int rowid, Student *out) {
+    if (!student_cache.fp || rowid < 0 || rowid >= cache_row_count()) return false;
+    CachePage *pg = cache_get_page(rowid / CACHE_PAGE_ROWS);
+    size_t idx = rowid % CACHE_PAGE_ROWS;
+    if (idx >= pg->rows.size() || !pg->rows[idx].reg_no[0]) return false;
+    *out = pg->rows[idx];
+    return true;
+}
+
+/* The resident copy of a row, or NULL if its page is not loaded */
+static Student *cache_resident_row(int rowid) {
+    int f = student_cache.page_frame[rowid / CACHE_PAGE_ROWS];
+    if (f < 0) return NULL;
+    std::vector<Student> &rows = student_cache.frames[f].rows;
+    size_t idx = rowid % CACHE_PAGE_ROWS;
+    return idx < rows.size() ? &rows[idx] : NULL;
+}
+
+/* Read one record for a scattered lookup: from its page when resident, otherwise as
+   a single line, so lookups spread over the file do not evict the pages in view */
+static bool cache_peek(int rowid, Student *out) {
+    if (!student_cache.fp || rowid < 0 || rowid >= cache_row_count()) return false;
+    Student *resident = cache_resident_row(rowid);
+    if (resident) {
+        if (!resident->reg_no[0]) return false;
+        *out = *resident;
+        return true;
+    }
+    return cache_read_row_direct(rowid, out);
+}
+
+/* Look up a registration number; returns its row id or -1 */
+static int cache_find_regno(const char *reg) {
+    unsigned h = regno_hash(reg);
+    RegIndexEntry key = { h, -1 };
+    std::vector<RegIndexEntry>::const_iterator it =
+        std::lower_bound(student_cache.regno_index.begin(), student_cache.regno_index.end(), key, regno_entry_less);
+    Student s;
+    for (; it != student_cache.regno_index.end() && it->hash == h; ++it) {
+        if (cache_read_row_direct(it->rowid, &s) && strcmp(s.reg_no, reg) == 0) return it->rowid;
+    }
+    for (size_t i = 0; i < student_cache.regno_tail.size(); i++) {
+        const RegIndexEntry &e = student_cache.regno_tail[i];
+        if (e.hash == h && cache_read_row_direct(e.rowid, &s) && strcmp(s.reg_no, reg) == 0) return e.rowid;
+    }
+    return -1;
+}
+
+/* Register a record appended at the given file offset; returns its row id */
+static int cache_note_append(long long offset, const Student *s) {
+    int rowid = cache_row_count();
+    cache_push_offset(offset);
+    RegIndexEntry e = { regno_hash(s->reg_no), rowid };
+    student_cache.regno_tail.push_back(e);
+    int page_no = rowid / CACHE_PAGE_ROWS;
+    if (page_no < (int)student_cache.page_frame.size()) {
+        /* the last page gained a row; keep it resident and add the row to it */
+        int f = student_cache.page_frame[page_no];
+        if (f >= 0) student_cache.frames[f].rows.push_back(*s);
+    } else {
+        student_cache.page_frame.push_back(-1);
+    }
+    return rowid;
+}
+
+/* Copy `len` bytes from `in` to `out`, or everything up to EOF when `len` is negative */
+static bool copy_file_bytes(FILE *in, FILE *out, long long len, std::vector<char> &buf) {
+    while (len != 0) {
+        size_t want = (len < 0 || (size_t)len > buf.size()) ? buf.size() : (size_t)len;
+        size_t got = fread(buf.data(), 1, want, in);
+        if (got == 0) return len < 0;
+        if (fwrite(buf.data(), 1, got, out) != got) return false;
+        if (len > 0) len -= (long long)got;
+    }
+    return true;
+}
+
+/* Move `from` over `to` in one step; `to` is left untouched when this fails */
+static bool replace_file(const char *from, const char *to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+/* Rewrite students.txt with one record replaced, or dropped when `s` is NULL.
+   Every edit copies the whole file to STUDENT_TMP_FILE (a block copy, nothing
+   is re-parsed) and moves it over students.txt; the offsets of later rows are
+   shifted by the change in line length only once the move has succeeded. */
+static bool cache_rewrite_row(int rowid, const Student *s) {
+    if (!student_cache.fp || rowid < 0 || rowid >= cache_row_count() || cache_is_deleted(rowid)) return false;
+    long long at = cache_row_offset(rowid);
+    char line[512];
+    if (srms_fseek(student_cache.fp, at, SEEK_SET) != 0 || !fgets(line, sizeof(line), student_cache.fp)) return false;
+    long long old_len = (long long)strlen(line);
+
+    FILE *out = fopen(STUDENT_TMP_FILE, "wb");
+    if (!out) return false;
+    std::vector<char> buf(LOAD_IO_BUFFER);
+    srms_fseek(student_cache.fp, 0, SEEK_SET);
+    bool ok = copy_file_bytes(student_cache.fp, out, at, buf);
+    long long new_len = 0;
+    if (ok && s) {
+        new_len = fprintf(out, "%s %s %d %d %.2f %.2f %.2f %.2f\n", s->reg_no, s->name, s->year, s->semester,
+                          s->cgpa[0], s->cgpa[1], s->cgpa[2], s->cgpa[3]);
+        ok = new_len > 0;
+    }
+    if (ok) {
+        srms_fseek(student_cache.fp, at + old_len, SEEK_SET);
+        ok = copy_file_bytes(student_cache.fp, out, -1, buf);
+    }
+    if (fclose(out) != 0) ok = false;
+    if (!ok) {
+        remove(STUDENT_TMP_FILE);
+        return false;
+    }
+
+    /* swap the new file in (Windows cannot replace an open file) and reopen
+       whichever file is now in place */
+    fclose(student_cache.fp);
+    bool swapped = replace_file(STUDENT_TMP_FILE, STUDENT_FILE);
+    student_cache.fp = fopen(STUDENT_FILE, "rb");
+    if (!swapped) {
+        remove(STUDENT_TMP_FILE);
+        return false;
+    }
+    /* later rows of the same page move relative to its base; later pages move as a whole */
+    long long delta = new_len - old_len;
+    if (delta != 0) {
+        int page_no = rowid / CACHE_PAGE_ROWS;
+        int page_end = std::min((page_no + 1) * CACHE_PAGE_ROWS, cache_row_count());
+        for (int r = rowid + 1; r < page_end; r++) student_cache.row_delta[r] += (unsigned)delta;
+        for (size_t p = page_no + 1; p < student_cache.page_base.size(); p++) student_cache.page_base[p] += delta;
+    }
+    return student_cache.fp != NULL;
+}
+
+/* Replace a record in the file and in its resident page */
+static bool cache_update_row(int rowid, const Student *s) {
+    Student old;
+    if (!cache_fetch(rowid, &old) || !cache_rewrite_row(rowid, s)) return false;
+    Student *resident = cache_resident_row(rowid);
+    if (resident) *resident = *s;
+    if (strcmp(old.name, s->name) != 0) name_index_update(rowid, old.name, s->name);
+    return true;
+}
+
+/* Remove a record from the file; its row id is retired until the next load and
+   name search skips it */
+static bool cache_delete_row(int rowid) {
+    if (!cache_rewrite_row(rowid, NULL)) return false;
+    student_cache.deleted.insert(std::upper_bound(student_cache.deleted.begin(), student_cache.deleted.end(), rowid), rowid);
+    Student *resident = cache_resident_row(rowid);
+    if (resident) resident->reg_no[0] = '\0';
+    return true;
+}
+
+/* Show hit/miss counters in the main window */
+static void cache_update_status() {
+    if (!student_cache.status_label) return;
+    size_t resident = 0;
+    for (size_t i = 0; i < student_cache.frames.size(); i++)
+        if (student_cache.frames[i].page_no >= 0) resident++;
+    unsigned long total = student_cache.hits + student_cache.misses;
+    char buf[320];
+    snprintf(buf, sizeof(buf), "Records: %d (loaded in %.0f ms, %d threads) | Cache (%s): %lu hits, %lu misses (%.1f%% hit), %lu evictions, %zu/%zu pages",
+             cache_visible_count(), student_cache.load_ms, student_cache.load_threads, student_cache.policy == CACHE_CLOCK ? "CLOCK" : "LRU",
+             student_cache.hits, student_cache.misses, total ? 100.0 * student_cache.hits / total : 0.0,
+             student_cache.evictions, resident, student_cache.frames.size());
+    gtk_label_set_text(GTK_LABEL(student_cache.status_label), buf);
+}
+
+/* Tree model over the record cache. The view asks for rows as it draws them and
+   each one is fetched through StudentCache, so no per-record state is kept
+   outside the cache. Iters carry the row id (an index into the session's
+   records for a filtered view), which stays valid across other rows' edits. */
+typedef struct {
+    GObject parent;
+    gint stamp;
+    bool filtered;  /* serve the session's rows instead of the whole roster */
+    int memo_rowid; /* last record fetched, reused for the other columns of its row */
+    Student memo;
+} RosterModel;
+
+typedef struct {
+    GObjectClass parent_class;
+} RosterModelClass;
+
+static void roster_model_tree_model_init(GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(RosterModel, roster_model, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL, roster_model_tree_model_init))
+
+#define ROSTER_MODEL(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), roster_model_get_type(), RosterModel))
+
+static void roster_model_init(RosterModel *rm) {
+    rm->stamp = (gint)g_random_int();
+    rm->filtered = false;
+    rm->memo_rowid = -1;
+}
+
+static void roster_model_class_init(RosterModelClass *klass) {
+}
+
+static int roster_model_count(RosterModel *rm) {
+    return rm->filtered ? (int)current_session.rows.size() : cache_visible_count();
+}
+
+static gboolean roster_model_set_iter(RosterModel *rm, GtkTreeIter *iter, int pos) {
+    if (pos < 0 || pos >= roster_model_count(rm)) return FALSE;
+    iter->stamp = rm->stamp;
+    iter->user_data = GINT_TO_POINTER(rm->filtered ? pos : cache_rowid_at(pos));
+    return TRUE;
+}
+
+static int roster_iter_rowid(GtkTreeIter *iter) {
+    return GPOINTER_TO_INT(iter->user_data);
+}
+
+static int roster_model_pos(RosterModel *rm, GtkTreeIter *iter) {
+    int id = roster_iter_rowid(iter);
+    return rm->filtered ? id : cache_pos_of(id);
+}
+
+static bool roster_model_record(RosterModel *rm, int id, Student *out) {
+    if (rm->filtered) {
+        if (id < 0 || id >= (int)current_session.rows.size()) return false;
+        *out = current_session.records[id];
+        return true;
+    }
+    if (id != rm->memo_rowid) {
+        if (!cache_fetch(id, &rm->memo)) return false;
+        rm->memo_rowid = id;
+    }
+    *out = rm->memo;
+    return true;
+}
+
+static GtkTreeModelFlags roster_model_get_flags(GtkTreeModel *model) {
+    return (GtkTreeModelFlags)(GTK_TREE_MODEL_LIST_ONLY | GTK_TREE_MODEL_ITERS_PERSIST);
+}
+
+static gint roster_model_get_n_columns(GtkTreeModel *model) {
+    return N_COLUMNS;
+}
+
+static GType roster_model_get_column_type(GtkTreeModel *model, gint column) {
+    switch (column) {
+    case COL_REGNO:
+    case COL_NAME:
+        return G_TYPE_STRING;
+    case COL_YEAR:
+    case COL_SEM:
+        return G_TYPE_INT;
+    default:
+        return G_TYPE_DOUBLE;
+    }
+}
+
+static gboolean roster_model_get_iter(GtkTreeModel *model, GtkTreeIter *iter, GtkTreePath *path) {
+    if (gtk_tree_path_get_depth(path) != 1) return FALSE;
+    return roster_model_set_iter(ROSTER_MODEL(model), iter, gtk_tree_path_get_indices(path)[0]);
+}
+
+static GtkTreePath *roster_model_get_path(GtkTreeModel *model, GtkTreeIter *iter) {
+    return gtk_tree_path_new_from_indices(roster_model_pos(ROSTER_MODEL(model), iter), -1);
+}
+
+static void roster_model_get_value(GtkTreeModel *model, GtkTreeIter *iter, gint column, GValue *value) {
+    g_value_init(value, roster_model_get_column_type(model, column));
+    Student s;
+    if (!roster_model_record(ROSTER_MODEL(model), roster_iter_rowid(iter), &s)) return;
+    switch (column) {
+    case COL_REGNO: g_value_set_string(value, s.reg_no); break;
+    case COL_NAME: g_value_set_string(value, s.name); break;
+    case COL_YEAR: g_value_set_int(value, s.year); break;
+    case COL_SEM: g_value_set_int(value, s.semester); break;
+    default: g_value_set_double(value, s.cgpa[column - COL_CGPA1]); break;
+    }
+}
+
+static gboolean roster_model_iter_next(GtkTreeModel *model, GtkTreeIter *iter) {
+    RosterModel *rm = ROSTER_MODEL(model);
+    return roster_model_set_iter(rm, iter, roster_model_pos(rm, iter) + 1);
+}
+
+static gboolean roster_model_iter_children(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent) {
+    if (parent) return FALSE;
+    return roster_model_set_iter(ROSTER_MODEL(model), iter, 0);
+}
+
+static gboolean roster_model_iter_has_child(GtkTreeModel *model, GtkTreeIter *iter) {
+    return FALSE;
+}
+
+static gint roster_model_iter_n_children(GtkTreeModel *model, GtkTreeIter *iter) {
+    return iter ? 0 : roster_model_count(ROSTER_MODEL(model));
+}
+
+static gboolean roster_model_iter_nth_child(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent, gint n) {
+    if (parent) return FALSE;
+    return roster_model_set_iter(ROSTER_MODEL(model), iter, n);
+}
+
+static gboolean roster_model_iter_parent(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *child) {
+    return FALSE;
+}
+
+static void roster_model_tree_model_init(GtkTreeModelIface *iface) {
+    iface->get_flags = roster_model_get_flags;
+    iface->get_n_columns = roster_model_get_n_columns;
+    iface->get_column_type = roster_model_get_column_type;
+    iface->get_iter = roster_model_get_iter;
+    iface->get_path = roster_model_get_path;
+    iface->get_value = roster_model_get_value;
+    iface->iter_next = roster_model_iter_next;
+    iface->iter_children = roster_model_iter_children;
+    iface->iter_has_child = roster_model_iter_has_child;
+    iface->iter_n_children = roster_model_iter_n_children;
+    iface->iter_nth_child = roster_model_iter_nth_child;
+    iface->iter_parent = roster_model_iter_parent;
 }
 
-/* Save liststore contents to students.txt */
-static void save_store_to_file(GtkListStore *store) {
-    FILE *fp = fopen(STUDENT_FILE, "w");
+static RosterModel *roster_model_new(bool filtered) {
+    RosterModel *rm = ROSTER_MODEL(g_object_new(roster_model_get_type(), NULL));
+    rm->filtered = filtered;
+    return rm;
+}
+
+/* Iter for a live row id of the full roster */
+static gboolean roster_model_iter_for_rowid(GtkTreeModel *model, int rowid, GtkTreeIter *iter) {
+    RosterModel *rm = ROSTER_MODEL(model);
+    if (rm->filtered || rowid < 0 || rowid >= cache_row_count() || cache_is_deleted(rowid)) return FALSE;
+    iter->stamp = rm->stamp;
+    iter->user_data = GINT_TO_POINTER(rowid);
+    return TRUE;
+}
+
+/* Drop the memoized record after the cache changed under the model */
+static void roster_model_invalidate(GtkTreeModel *model) {
+    ROSTER_MODEL(model)->memo_rowid = -1;
+}
+
+/* Load the pages around the visible part of the tree view, one page either side */
+static void prefetch_visible(GtkTreeView *tree) {
+    GtkTreeModel *model = gtk_tree_view_get_model(tree);
+    GtkTreePath *start = NULL, *end = NULL;
+    if (model && !ROSTER_MODEL(model)->filtered && student_cache.fp && gtk_tree_view_get_visible_range(tree, &start, &end)) {
+        int first = cache_rowid_at(gtk_tree_path_get_indices(start)[0]) / CACHE_PAGE_ROWS - 1;
+        int last = cache_rowid_at(gtk_tree_path_get_indices(end)[0]) / CACHE_PAGE_ROWS + 1;
+        gtk_tree_path_free(start);
+        gtk_tree_path_free(end);
+        if (first < 0) first = 0;
+        if (last >= (int)student_cache.page_frame.size()) last = (int)student_cache.page_frame.size() - 1;
+        for (int p = first; p <= last; p++) cache_get_page(p);
+    }
+    cache_update_status();
+}
+
+/* Filtered session: scan students.txt only up to the linked record and keep just that row */
+static void refresh_own_record() {
+    current_session.rows.clear();
+    current_session.records.clear();
+    FILE *fp = fopen(STUDENT_FILE, "rb");
     if (!fp) return;
-    GtkTreeIter iter;
-    gboolean valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(store), &iter);
-    while (valid) {
-        char *regno = nullptr;
-        char *name = nullptr;
-        int year = 0, sem = 0;
-        double cg1 = 0.0, cg2 = 0.0, cg3 = 0.0, cg4 = 0.0;
-        gtk_tree_model_get(GTK_TREE_MODEL(store), &iter,
-                           COL_REGNO, &regno,
-                           COL_NAME, &name,
-                           COL_YEAR, &year,
-                           COL_SEM, &sem,
-                           COL_CGPA1, &cg1,
-                           COL_CGPA2, &cg2,
-                           COL_CGPA3, &cg3,
-                           COL_CGPA4, &cg4,
-                           -1);
-        /* regno and name are freshly allocated by gtk_tree_model_get for string columns */
-        if (regno && name) {
-            fprintf(fp, "%s %s %d %d %.2f %.2f %.2f %.2f\n", regno, name, year, sem, cg1, cg2, cg3, cg4);
+    char line[512];
+    Student s;
+    int rowid = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (!parse_student_line(line, &s)) continue;
+        if (strcmp(s.reg_no, current_session.reg_no) == 0) {
+            current_session.rows.push_back(rowid);
+            current_session.records.push_back(s);
+            break;
         }
-        if (regno) g_free(regno);
-        if (name) g_free(name);
-        valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(store), &iter);
+        rowid++;
     }
     fclose(fp);
 }
 
+/* Index students.txt and give the tree a fresh model over the cache; rows are read on demand.
+   A session that may not view the roster gets a filtered model over its own rows, which
+   stay empty unless it holds CAP_VIEW_SELF */
+static void refresh_tree_store(GtkTreeView *tree) {
+    gint64 t0 = g_get_monotonic_time();
+    bool filtered = !session_can(CAP_VIEW_ALL);
+    if (!filtered) {
+        if (!cache_build_index()) show_message(NULL, "Error", "Cannot read students file; the list is empty.");
+    } else if (session_can(CAP_VIEW_SELF)) {
+        refresh_own_record();
+    } else {
+        current_session.rows.clear();
+        current_session.records.clear();
+    }
+    RosterModel *model = roster_model_new(filtered);
+    gtk_tree_view_set_model(tree, GTK_TREE_MODEL(model));
+    g_object_unref(model); /* the tree view holds the only reference */
+    student_cache.load_ms = (g_get_monotonic_time() - t0) / 1000.0;
+    cache_update_status();
+}
+
+/* Grade history: parse one history.txt line ("reg_no sem timestamp sgpa cgpa"); a grade is "-" when not given */
+static bool parse_history_line(const char *line, char *reg, int *sem, long long *ts, bool *has_sgpa, double *sgpa, bool *has_cgpa, double *cgpa) {
+    char sg[16], cg[16];
+    if (sscanf(line, "%31s %d %lld %15s %15s", reg, sem, ts, sg, cg) != 5) return false;
+    *has_sgpa = strcmp(sg, "-") != 0;
+    *sgpa = *has_sgpa ? atof(sg) : 0.0;
+    *has_cgpa = strcmp(cg, "-") != 0;
+    *cgpa = *has_cgpa ? atof(cg) : 0.0;
+    return true;
+}
+
+static int grade_to_centi(double g) {
+    if (g < 0.0) g = 0.0;
+    if (g > 100.0) g = 100.0;
+    return (int)(g * 100.0 + (g < 0 ? -0.5 : 0.5));
+}
+
+/* Append a zigzag varint to a byte column */
+static void put_varint(std::vector<unsigned char> &col, long long v) {
+    unsigned long long z = ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63);
+    while (z >= 0x80) { col.push_back((unsigned char)(z | 0x80)); z >>= 7; }
+    col.push_back((unsigned char)z);
+}
+
+static long long get_varint(const std::vector<unsigned char> &col, size_t *pos) {
+    unsigned long long z = 0;
+    int shift = 0;
+    while (*pos < col.size()) {
+        unsigned char b = col[(*pos)++];
+        z |= (unsigned long long)(b & 0x7f) << shift;
+        if (!(b & 0x80)) break;
+        shift += 7;
+    }
+    return (long long)(z >> 1) ^ -(long long)(z & 1);
+}
+
+/* Return the series id for a reg_no, creating an empty series if needed */
+static int history_series_for(const char *reg) {
+    std::unordered_map<std::string, int>::const_iterator it = grade_history.series_of.find(reg);
+    if (it != grade_history.series_of.end()) return it->second;
+    int id = (int)grade_history.reg_nos.size();
+    grade_history.series_of[reg] = id;
+    grade_history.reg_nos.push_back(reg);
+    grade_history.last_sem.push_back(0);
+    grade_history.prev_sem.push_back(0);
+    grade_history.last_sgpa.push_back(0);
+    grade_history.last_cgpa.push_back(0);
+    grade_history.prev_cgpa.push_back(0);
+    grade_history.entries.push_back(std::vector<int>());
+    return id;
+}
+
+/* Add one entry to the in-memory columns (no file I/O); a missing grade repeats the student's previous one */
+static void history_append_mem(const char *reg, int sem, long long ts, bool has_sgpa, double sgpa, bool has_cgpa, double cgpa) {
+    int id = history_series_for(reg);
+    int s = has_sgpa ? grade_to_centi(sgpa) : grade_history.last_sgpa[id];
+    int c = has_cgpa ? grade_to_centi(cgpa) : grade_history.last_cgpa[id];
+    if (grade_history.series.size() % HISTORY_CHECKPOINT_ENTRIES == 0) {
+        grade_history.ckpt_pos.push_back(grade_history.ts_delta.size());
+        grade_history.ckpt_ts.push_back(grade_history.last_ts);
+    }
+    grade_history.series.push_back(id);
+    grade_history.semester.push_back((unsigned char)sem);
+    put_varint(grade_history.ts_delta, ts - grade_history.last_ts);
+    grade_history.sgpa_delta.push_back((short)(s - grade_history.last_sgpa[id]));
+    grade_history.sgpa_present.push_back(has_sgpa);
+    grade_history.cgpa_delta.push_back((short)(c - grade_history.last_cgpa[id]));
+    grade_history.cgpa_present.push_back(has_cgpa);
+    grade_history.last_ts = ts;
+    if (!grade_history.entries[id].empty() && sem != grade_history.last_sem[id]) {
+        grade_history.prev_cgpa[id] = grade_history.last_cgpa[id];
+        grade_history.prev_sem[id] = grade_history.last_sem[id];
+    } else if (!grade_history.prev_sem[id]) {
+        grade_history.prev_cgpa[id] = (short)c; /* no earlier semester: nothing to drop from */
+    }
+    grade_history.last_cgpa[id] = (short)c;
+    grade_history.last_sgpa[id] = (short)s;
+    grade_history.last_sem[id] = (unsigned char)sem;
+    grade_history.entries[id].push_back((int)grade_history.series.size() - 1);
+}
+
+/* Load history.txt once per session */
+static void history_load() {
+    if (grade_history.loaded) return;
+    grade_history.loaded = true;
+    FILE *fp = fopen(HISTORY_FILE, "r");
+    if (!fp) return;
+    char line[256], reg[32];
+    int sem = 0;
+    long long ts = 0;
+    bool has_sgpa = false, has_cgpa = false;
+    double sgpa = 0.0, cgpa = 0.0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (parse_history_line(line, reg, &sem, &ts, &has_sgpa, &sgpa, &has_cgpa, &cgpa)) history_append_mem(reg, sem, ts, has_sgpa, sgpa, has_cgpa, cgpa);
+    }
+    fclose(fp);
+}
+
+/* Record a semester entry: one appended line plus the in-memory columns */
+static void history_record(const char *reg, int sem, bool has_sgpa, double sgpa, bool has_cgpa, double cgpa) {
+    history_load();
+    long long ts = (long long)time(NULL);
+    FILE *fp = fopen(HISTORY_FILE, "a");
+    if (fp) {
+        char sg[16] = "-", cg[16] = "-";
+        if (has_sgpa) snprintf(sg, sizeof(sg), "%.2f", sgpa);
+        if (has_cgpa) snprintf(cg, sizeof(cg), "%.2f", cgpa);
+        fprintf(fp, "%s %d %lld %s %s\n", reg, sem, ts, sg, cg);
+        fclose(fp);
+    }
+    history_append_mem(reg, sem, ts, has_sgpa, sgpa, has_cgpa, cgpa);
+}
+
+/* Decode the entries of one student, oldest first */
+static std::vector<HistoryEntry> history_series_entries(const char *reg) {
+    std::vector<HistoryEntry> out;
+    std::unordered_map<std::string, int>::const_iterator it = grade_history.series_of.find(reg);
+    if (it == grade_history.series_of.end()) return out;
+    const std::vector<int> &idx = grade_history.entries[it->second];
+    size_t pos = 0, next = 0; /* `pos` is where the timestamp delta of entry `next` starts */
+    long long ts = 0;
+    int s = 0, c = 0;
+    for (size_t k = 0; k < idx.size(); k++) {
+        size_t i = (size_t)idx[k];
+        size_t ck = i / HISTORY_CHECKPOINT_ENTRIES;
+        if (ck * HISTORY_CHECKPOINT_ENTRIES > next) {
+            next = ck * HISTORY_CHECKPOINT_ENTRIES;
+            pos = grade_history.ckpt_pos[ck];
+            ts = grade_history.ckpt_ts[ck];
+        }
+        while (next <= i) { ts += get_varint(grade_history.ts_delta, &pos); next++; }
+        s += grade_history.sgpa_delta[i];
+        c += grade_history.cgpa_delta[i];
+        HistoryEntry e = { grade_history.semester[i], ts, grade_history.sgpa_present[i], s / 100.0,
+                            grade_history.cgpa_present[i], c / 100.0 };
+        out.push_back(e);
+    }
+    return out;
+}
+
+/* Series ids whose CGPA fell by more than `drop` between their last two semesters, largest drop first */
+static std::vector<int> history_cgpa_drops(double drop) {
+    std::vector<int> ids;
+    int limit = grade_to_centi(drop);
+    const short *last = grade_history.last_cgpa.data();
+    const short *prev = grade_history.prev_cgpa.data();
+    int n = (int)grade_history.reg_nos.size();
+    for (int i = 0; i < n; i++) {
+        if (prev[i] - last[i] > limit) ids.push_back(i);
+    }
+    std::sort(ids.begin(), ids.end(), [&](int a, int b) { return prev[a] - last[a] > prev[b] - last[b]; });
+    return ids;
+}
+
 /* Add Student dialog */
-static void show_add_student_dialog(GtkWindow *parent, GtkListStore *store) {
+static void show_add_student_dialog(GtkWindow *parent, GtkTreeView *tree) {
     /* Only ADMIN and STAFF allowed (should check before calling, but double-check here) */
-    if (!(strcmp(current_role, "ADMIN") == 0 || strcmp(current_role, "STAFF") == 0)) {
+    if (!session_can(CAP_MODIFY)) {
         show_message(parent, "Permission denied", "Only admin and staff can add students.");
         return;
     }
@@ -228,6 +1586,8 @@ static void show_add_student_dialog(GtkWindow *parent, GtkListStore *store) {
 
         if (strlen(reg) == 0 || strlen(name) == 0 || strlen(syear) == 0 || strlen(ssem) == 0) {
             show_message(parent, "Error", "Registration number, name, year and semester are required.");
+        } else if (has_whitespace(reg) || has_whitespace(name)) {
+            show_message(parent, "Error", "Registration number and name cannot contain spaces (use _ instead).");
         } else {
             int year = atoi(syear);
             int sem = atoi(ssem);
@@ -240,21 +1600,26 @@ static void show_add_student_dialog(GtkWindow *parent, GtkListStore *store) {
             if (!fp) {
                 show_message(parent, "Error", "Cannot open students file for writing.");
             } else {
-                fprintf(fp, "%s %s %d %d %.2f %.2f %.2f %.2f\n", reg, name, year, sem, cg1, cg2, cg3, cg4);
+                srms_fseek(fp, 0, SEEK_END);
+                long long offset = srms_ftell(fp);
+                /* the file, the cache and the name index all get the truncated fields */
+                Student s;
+                strncpy(s.reg_no, reg, sizeof(s.reg_no)-1); s.reg_no[sizeof(s.reg_no)-1] = '\0';
+                strncpy(s.name, name, sizeof(s.name)-1); s.name[sizeof(s.name)-1] = '\0';
+                s.year = year; s.semester = sem; s.cgpa[0] = cg1; s.cgpa[1] = cg2; s.cgpa[2] = cg3; s.cgpa[3] = cg4;
+                fprintf(fp, "%s %s %d %d %.2f %.2f %.2f %.2f\n", s.reg_no, s.name, year, sem, cg1, cg2, cg3, cg4);
                 fclose(fp);
-                /* Add to store */
+                int rowid = cache_note_append(offset, &s);
+                name_index_add(rowid, s.name);
+                /* Show the new row */
+                GtkTreeModel *model = gtk_tree_view_get_model(tree);
                 GtkTreeIter iter;
-                gtk_list_store_append(store, &iter);
-                gtk_list_store_set(store, &iter,
-                                   COL_REGNO, reg,
-                                   COL_NAME, name,
-                                   COL_YEAR, year,
-                                   COL_SEM, sem,
-                                   COL_CGPA1, cg1,
-                                   COL_CGPA2, cg2,
-                                   COL_CGPA3, cg3,
-                                   COL_CGPA4, cg4,
-                                   -1);
+                if (roster_model_iter_for_rowid(model, rowid, &iter)) {
+                    GtkTreePath *path = gtk_tree_model_get_path(model, &iter);
+                    gtk_tree_model_row_inserted(model, path, &iter);
+                    gtk_tree_path_free(path);
+                }
+                cache_update_status();
                 show_message(parent, "Success", "Student added.");
             }
         }
@@ -264,9 +1629,9 @@ static void show_add_student_dialog(GtkWindow *parent, GtkListStore *store) {
 }
 
 /* Update dialog - using local copy of student data and iter (safe) */
-static void show_update_student_dialog(GtkWindow *parent, GtkListStore *store, Student student, GtkTreeIter iter) {
+static void show_update_student_dialog(GtkWindow *parent, GtkTreeView *tree, Student student, GtkTreeIter iter) {
     /* Only ADMIN and STAFF allowed */
-    if (!(strcmp(current_role, "ADMIN") == 0 || strcmp(current_role, "STAFF") == 0)) {
+    if (!session_can(CAP_MODIFY)) {
         show_message(parent, "Permission denied", "Only admin and staff can update students.");
         return;
     }
@@ -289,6 +1654,7 @@ static void show_update_student_dialog(GtkWindow *parent, GtkListStore *store, S
     GtkWidget *cg2_label = gtk_label_new("CGPA Year2:");
     GtkWidget *cg3_label = gtk_label_new("CGPA Year3:");
     GtkWidget *cg4_label = gtk_label_new("CGPA Year4:");
+    GtkWidget *sgpa_label = gtk_label_new("SGPA (this sem):");
 
     GtkWidget *reg_entry = gtk_entry_new();
     GtkWidget *name_entry = gtk_entry_new();
@@ -298,6 +1664,7 @@ static void show_update_student_dialog(GtkWindow *parent, GtkListStore *store, S
     GtkWidget *cg2_entry = gtk_entry_new();
     GtkWidget *cg3_entry = gtk_entry_new();
     GtkWidget *cg4_entry = gtk_entry_new();
+    GtkWidget *sgpa_entry = gtk_entry_new();
 
     gtk_entry_set_text(GTK_ENTRY(reg_entry), student.reg_no);
     gtk_widget_set_sensitive(reg_entry, FALSE); /* reg no shouldn't be changed */
@@ -330,6 +1697,22 @@ static void show_update_student_dialog(GtkWindow *parent, GtkListStore *store, S
     gtk_grid_attach(GTK_GRID(grid), cg3_entry, 1, 6, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), cg4_label, 0, 7, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), cg4_entry, 1, 7, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), sgpa_label, 0, 8, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), sgpa_entry, 1, 8, 1, 1);
+
+    /* last few semesters from the grade history */
+    history_load();
+    std::vector<HistoryEntry> hist = history_series_entries(student.reg_no);
+    std::string hist_text = hist.empty() ? "No grade history yet." : "Recent semesters:";
+    for (size_t h = hist.size() > HISTORY_SHOWN ? hist.size() - HISTORY_SHOWN : 0; h < hist.size(); h++) {
+        char line[96], sgpa[16] = "-", cgpa[16] = "-";
+        if (hist[h].has_sgpa) snprintf(sgpa, sizeof(sgpa), "%.2f", hist[h].sgpa);
+        if (hist[h].has_cgpa) snprintf(cgpa, sizeof(cgpa), "%.2f", hist[h].cgpa);
+        snprintf(line, sizeof(line), "\nSem %d: SGPA %s  CGPA %s", hist[h].semester, sgpa, cgpa);
+        hist_text += line;
+    }
+    GtkWidget *hist_label = gtk_label_new(hist_text.c_str());
+    gtk_grid_attach(GTK_GRID(grid), hist_label, 0, 9, 2, 1);
 
     gtk_container_add(GTK_CONTAINER(content), grid);
     gtk_widget_show_all(dlg);
@@ -343,9 +1726,12 @@ static void show_update_student_dialog(GtkWindow *parent, GtkListStore *store, S
         const char *scg2 = gtk_entry_get_text(GTK_ENTRY(cg2_entry));
         const char *scg3 = gtk_entry_get_text(GTK_ENTRY(cg3_entry));
         const char *scg4 = gtk_entry_get_text(GTK_ENTRY(cg4_entry));
+        const char *ssgpa = gtk_entry_get_text(GTK_ENTRY(sgpa_entry));
 
         if (strlen(name) == 0 || strlen(syear) == 0 || strlen(ssem) == 0) {
             show_message(parent, "Error", "Name, year and semester are required.");
+        } else if (has_whitespace(name)) {
+            show_message(parent, "Error", "Name cannot contain spaces (use _ instead).");
         } else {
             int year = atoi(syear), sem = atoi(ssem);
             double cg1 = (strlen(scg1) ? atof(scg1) : 0.0);
@@ -353,17 +1739,30 @@ static void show_update_student_dialog(GtkWindow *parent, GtkListStore *store, S
             double cg3 = (strlen(scg3) ? atof(scg3) : 0.0);
             double cg4 = (strlen(scg4) ? atof(scg4) : 0.0);
 
-            /* update the store using iter (safe because iter is from selection immediately before) */
-            gtk_list_store_set(store, &iter,
-                               COL_NAME, name,
-                               COL_YEAR, year,
-                               COL_SEM, sem,
-                               COL_CGPA1, cg1,
-                               COL_CGPA2, cg2,
-                               COL_CGPA3, cg3,
-                               COL_CGPA4, cg4,
-                               -1);
-            save_store_to_file(store);
+            /* write the record through the cache; the iter carries its row id */
+            Student s = student;
+            strncpy(s.name, name, sizeof(s.name)-1); s.name[sizeof(s.name)-1] = '\0';
+            s.year = year; s.semester = sem; s.cgpa[0] = cg1; s.cgpa[1] = cg2; s.cgpa[2] = cg3; s.cgpa[3] = cg4;
+            if (!cache_update_row(roster_iter_rowid(&iter), &s)) {
+                show_message(parent, "Error", "Cannot write students file.");
+                gtk_widget_destroy(dlg);
+                return;
+            }
+            GtkTreeModel *model = gtk_tree_view_get_model(tree);
+            roster_model_invalidate(model);
+            GtkTreePath *path = gtk_tree_model_get_path(model, &iter);
+            gtk_tree_model_row_changed(model, path, &iter);
+            gtk_tree_path_free(path);
+
+            /* history entry when a semester GPA is given or the current semester/CGPA changed.
+               There is no per-semester CGPA field, so the current year's CGPA column stands in
+               for it; that column is empty (0.00) right after a student moves up a year, so an
+               empty or zero value is recorded as missing rather than as a drop to 0. */
+            int yi = (year >= 1 && year <= 4) ? year - 1 : 0;
+            double cgs[4] = { cg1, cg2, cg3, cg4 };
+            if (strlen(ssgpa) || sem != student.semester || cgs[yi] != student.cgpa[yi]) {
+                history_record(student.reg_no, sem, strlen(ssgpa) > 0, atof(ssgpa), cgs[yi] > 0.0, cgs[yi]);
+            }
             show_message(parent, "Updated", "Record updated.");
         }
     }
@@ -374,7 +1773,7 @@ static void show_update_student_dialog(GtkWindow *parent, GtkListStore *store, S
 /* Delete selected student */
 static void delete_selected_student(GtkWindow *parent, GtkTreeView *treeview) {
     /* Only ADMIN and STAFF allowed */
-    if (!(strcmp(current_role, "ADMIN") == 0 || strcmp(current_role, "STAFF") == 0)) {
+    if (!session_can(CAP_MODIFY)) {
         show_message(parent, "Permission denied", "Only admin and staff can delete students.");
         return;
     }
@@ -417,15 +1816,21 @@ static void delete_selected_student(GtkWindow *parent, GtkTreeView *treeview) {
     gtk_widget_destroy(conf);
 
     if (res == GTK_RESPONSE_YES) {
-        GtkListStore *store = GTK_LIST_STORE(model);
-        gtk_list_store_remove(store, &iter);
-        save_store_to_file(store);
-        show_message(parent, "Deleted", "Record deleted.");
+        GtkTreePath *path = gtk_tree_model_get_path(model, &iter);
+        if (cache_delete_row(roster_iter_rowid(&iter))) {
+            roster_model_invalidate(model);
+            gtk_tree_model_row_deleted(model, path);
+            cache_update_status();
+            show_message(parent, "Deleted", "Record deleted.");
+        } else {
+            show_message(parent, "Error", "Cannot write students file.");
+        }
+        gtk_tree_path_free(path);
     }
 }
 
 /* Search a student by registration number (for students to view their own details) */
-static void show_search_by_regno_dialog(GtkWindow *parent, GtkListStore *store) {
+static void show_search_by_regno_dialog(GtkWindow *parent, GtkTreeView *tree) {
     GtkWidget *dlg = gtk_dialog_new_with_buttons("Find Student (by Reg No)", parent,
         (GtkDialogFlags)(GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT),
         "_Find", GTK_RESPONSE_OK, "_Cancel", GTK_RESPONSE_CANCEL, NULL);
@@ -444,28 +1849,25 @@ static void show_search_by_regno_dialog(GtkWindow *parent, GtkListStore *store)
         if (strlen(reg) == 0) {
             show_message(parent, "Error", "Please enter registration number.");
         } else {
+            GtkTreeModel *model = gtk_tree_view_get_model(tree);
             GtkTreeIter iter;
-            gboolean valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(store), &iter);
             gboolean found = FALSE;
-            while (valid) {
-                char *regno = nullptr;
-                gtk_tree_model_get(GTK_TREE_MODEL(store), &iter, COL_REGNO, &regno, -1);
-                if (regno) {
-                    if (strcmp(regno, reg) == 0) {
-                        g_free(regno);
-                        found = TRUE;
-                        break;
-                    }
-                    g_free(regno);
+            if (session_can(CAP_VIEW_ALL)) {
+                /* look the row up in the reg_no index; the model reads it through the cache */
+                found = roster_model_iter_for_rowid(model, cache_find_regno(reg), &iter);
+            } else {
+                /* filtered view: only the session's own rows are in the model */
+                for (size_t k = 0; k < current_session.rows.size() && !found; k++) {
+                    if (strcmp(current_session.records[k].reg_no, reg) == 0)
+                        found = gtk_tree_model_iter_nth_child(model, &iter, NULL, (gint)k);
                 }
-                valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(store), &iter);
             }
             if (found) {
                 char *regno = nullptr;
                 char *name = nullptr;
                 int year = 0, sem = 0;
                 double cg1 = 0.0, cg2 = 0.0, cg3 = 0.0, cg4 = 0.0;
-                gtk_tree_model_get(GTK_TREE_MODEL(store), &iter,
+                gtk_tree_model_get(model, &iter,
                                    COL_REGNO, &regno,
                                    COL_NAME, &name,
                                    COL_YEAR, &year,
@@ -490,14 +1892,111 @@ static void show_search_by_regno_dialog(GtkWindow *parent, GtkListStore *store)
     gtk_widget_destroy(dlg);
 }
 
+/* Fuzzy search by name: list the closest matches and select the best one in the tree */
+static void show_search_by_name_dialog(GtkWindow *parent, GtkTreeView *tree) {
+    GtkWidget *dlg = gtk_dialog_new_with_buttons("Find Student (by Name)", parent,
+        (GtkDialogFlags)(GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT),
+        "_Find", GTK_RESPONSE_OK, "_Cancel", GTK_RESPONSE_CANCEL, NULL);
+    GtkWidget *content = gtk_dialog_get_content_area(GTK_DIALOG(dlg));
+    GtkWidget *hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+    GtkWidget *label = gtk_label_new("Name:");
+    GtkWidget *entry = gtk_entry_new();
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), entry, TRUE, TRUE, 0);
+    gtk_container_add(GTK_CONTAINER(content), hbox);
+    gtk_widget_show_all(dlg);
+
+    gint res = gtk_dialog_run(GTK_DIALOG(dlg));
+    if (res == GTK_RESPONSE_OK) {
+        const char *query = gtk_entry_get_text(GTK_ENTRY(entry));
+        if (strlen(query) == 0) {
+            show_message(parent, "Error", "Please enter a name.");
+        } else {
+            gint64 t0 = g_get_monotonic_time();
+            std::vector<NameMatch> matches = name_index_search(query, NAME_MATCHES_LISTED);
+            double ms = (g_get_monotonic_time() - t0) / 1000.0;
+            if (matches.empty()) {
+                show_message(parent, "Not found", "No student with a similar name.");
+            } else {
+                std::string text;
+                char line[256];
+                snprintf(line, sizeof(line), "%zu closest match(es) in %.1f ms:", matches.size(), ms);
+                text += line;
+                for (size_t i = 0; i < matches.size(); i++) {
+                    Student s;
+                    if (!cache_peek(matches[i].rowid, &s)) continue;
+                    snprintf(line, sizeof(line), "\n%s  %s  (%d edit%s)", s.reg_no, s.name,
+                             matches[i].distance, matches[i].distance == 1 ? "" : "s");
+                    text += line;
+                }
+                /* select the best match and scroll the tree to it */
+                GtkTreeModel *model = gtk_tree_view_get_model(tree);
+                GtkTreeIter iter;
+                if (roster_model_iter_for_rowid(model, matches[0].rowid, &iter)) {
+                    GtkTreePath *path = gtk_tree_model_get_path(model, &iter);
+                    gtk_tree_selection_select_iter(gtk_tree_view_get_selection(tree), &iter);
+                    gtk_tree_view_scroll_to_cell(tree, path, NULL, FALSE, 0.0, 0.0);
+                    gtk_tree_path_free(path);
+                }
+                show_message(parent, "Name Matches", text.c_str());
+            }
+        }
+    }
+    gtk_widget_destroy(dlg);
+}
+
+/* List students whose CGPA dropped by more than a threshold since their previous semester */
+static void show_cgpa_trends_dialog(GtkWindow *parent) {
+    GtkWidget *dlg = gtk_dialog_new_with_buttons("CGPA Trends", parent,
+        (GtkDialogFlags)(GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT),
+        "_Find", GTK_RESPONSE_OK, "_Cancel", GTK_RESPONSE_CANCEL, NULL);
+    GtkWidget *content = gtk_dialog_get_content_area(GTK_DIALOG(dlg));
+    GtkWidget *hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+    GtkWidget *label = gtk_label_new("CGPA drop greater than:");
+    GtkWidget *entry = gtk_entry_new();
+    gtk_entry_set_text(GTK_ENTRY(entry), "0.50");
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), entry, TRUE, TRUE, 0);
+    gtk_container_add(GTK_CONTAINER(content), hbox);
+    gtk_widget_show_all(dlg);
+
+    gint res = gtk_dialog_run(GTK_DIALOG(dlg));
+    if (res == GTK_RESPONSE_OK) {
+        const char *sdrop = gtk_entry_get_text(GTK_ENTRY(entry));
+        history_load();
+        std::vector<int> ids = history_cgpa_drops(strlen(sdrop) ? atof(sdrop) : 0.5);
+        std::string text;
+        char line[128];
+        snprintf(line, sizeof(line), "%zu student(s) found.", ids.size());
+        text += line;
+        for (size_t i = 0; i < ids.size() && i < TRENDS_LISTED; i++) {
+            int id = ids[i];
+            snprintf(line, sizeof(line), "\n%s: %.2f -> %.2f (sem %d)", grade_history.reg_nos[id].c_str(),
+                     grade_history.prev_cgpa[id] / 100.0, grade_history.last_cgpa[id] / 100.0, grade_history.last_sem[id]);
+            text += line;
+        }
+        if (ids.size() > TRENDS_LISTED) text += "\n...";
+        show_message(parent, "CGPA Trends", text.c_str());
+    }
+    gtk_widget_destroy(dlg);
+}
+
 /* Main window and callbacks */
 static void add_btn_cb(GtkButton *b, gpointer user_data) {
     AppData *d = (AppData *)user_data;
-    show_add_student_dialog(d->parent, d->store);
+    show_add_student_dialog(d->parent, d->tree);
 }
 static void refresh_btn_cb(GtkButton *b, gpointer user_data) {
-    GtkListStore *store = (GtkListStore *)user_data;
-    refresh_tree_store(store);
+    AppData *d = (AppData *)user_data;
+    refresh_tree_store(d->tree);
+    prefetch_visible(d->tree);
+}
+static void tree_scrolled_cb(GtkAdjustment *adj, gpointer user_data) {
+    AppData *d = (AppData *)user_data;
+    prefetch_visible(d->tree);
+}
+static void status_label_destroy_cb(GtkWidget *w, gpointer user_data) {
+    if (student_cache.status_label == w) student_cache.status_label = NULL;
 }
 static void update_btn_cb(GtkButton *b, gpointer user_data) {
     AppData *d = (AppData *)user_data;
@@ -526,7 +2025,7 @@ static void update_btn_cb(GtkButton *b, gpointer user_data) {
     if (regno) { strncpy(s.reg_no, regno, sizeof(s.reg_no)-1); s.reg_no[sizeof(s.reg_no)-1] = '\0'; g_free(regno); } else s.reg_no[0] = '\0';
     if (name) { strncpy(s.name, name, sizeof(s.name)-1); s.name[sizeof(s.name)-1] = '\0'; g_free(name); } else s.name[0] = '\0';
     s.year = year; s.semester = sem; s.cgpa[0] = cg1; s.cgpa[1] = cg2; s.cgpa[2] = cg3; s.cgpa[3] = cg4;
-    show_update_student_dialog(d->parent, d->store, s, iter);
+    show_update_student_dialog(d->parent, d->tree, s, iter);
 }
 static void delete_btn_cb(GtkButton *b, gpointer user_data) {
     AppData *d = (AppData *)user_data;
@@ -534,22 +2033,29 @@ static void delete_btn_cb(GtkButton *b, gpointer user_data) {
 }
 static void search_btn_cb(GtkButton *b, gpointer user_data) {
     AppData *d = (AppData *)user_data;
-    /* STUDENT role should use this to view own details; ADMIN/STAFF/GUEST can also use */
-    if (strcmp(current_role, "USER") == 0) {
-        /* Student - allow only self view by reg no */
-        show_search_by_regno_dialog(d->parent, d->store);
-    } else if (strcmp(current_role, "GUEST") == 0) {
-        /* Guests can search and view */
-        show_search_by_regno_dialog(d->parent, d->store);
-    } else {
-        /* Admin/Staff can also search */
-        show_search_by_regno_dialog(d->parent, d->store);
-    }
+    /* every role can search; a VIEW_SELF session only sees rows in its filtered view */
+    show_search_by_regno_dialog(d->parent, d->tree);
+}
+static void name_search_btn_cb(GtkButton *b, gpointer user_data) {
+    AppData *d = (AppData *)user_data;
+    show_search_by_name_dialog(d->parent, d->tree);
+}
+static void trends_btn_cb(GtkButton *b, gpointer user_data) {
+    AppData *d = (AppData *)user_data;
+    show_cgpa_trends_dialog(d->parent);
 }
 static void logout_btn_cb(GtkButton *b, gpointer user_data) {
     GtkWindow *w = GTK_WINDOW(user_data);
     gtk_widget_destroy(GTK_WIDGET(w));
-    current_user[0] = '\0'; current_role[0] = '\0';
+    current_user[0] = '\0';
+    session_begin("", "");
+    cache_reset();
+    std::vector<long long>().swap(student_cache.page_base);
+    std::vector<unsigned>().swap(student_cache.row_delta);
+    std::vector<RegIndexEntry>().swap(student_cache.regno_index);
+    student_cache.regno_tail.clear();
+    student_cache.deleted.clear();
+    name_index_clear();
     show_login_dialog(nullptr);
 }
 static void row_activated_cb(GtkTreeView *tree, GtkTreePath *path, GtkTreeViewColumn *col, gpointer userdata) {
@@ -577,8 +2083,8 @@ static void row_activated_cb(GtkTreeView *tree, GtkTreePath *path, GtkTreeViewCo
             strncpy(s.name, name, sizeof(s.name)-1); s.name[sizeof(s.name)-1] = '\0';
             s.year = year; s.semester = sem; s.cgpa[0]=cg1; s.cgpa[1]=cg2; s.cgpa[2]=cg3; s.cgpa[3]=cg4;
             g_free(regno); g_free(name);
-            if (strcmp(current_role, "ADMIN") == 0 || strcmp(current_role, "STAFF") == 0) {
-                show_update_student_dialog(d->parent, d->store, s, iter);
+            if (session_can(CAP_MODIFY)) {
+                show_update_student_dialog(d->parent, d->tree, s, iter);
             } else {
                 /* show read-only message */
                 char info[512];
@@ -598,7 +2104,7 @@ static void show_main_window(GtkWindow *parent) {
 
     GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     char title[128];
-    snprintf(title, sizeof(title), "SRMS - User: %s (Role: %s)", current_user[0] ? current_user : "Unknown", current_role[0] ? current_role : "NONE");
+    snprintf(title, sizeof(title), "SRMS - User: %s (Role: %s)", current_user[0] ? current_user : "Unknown", role_name(current_session.role));
     gtk_window_set_title(GTK_WINDOW(window), title);
     gtk_window_set_default_size(GTK_WINDOW(window), 800, 500);
 
@@ -606,11 +2112,9 @@ static void show_main_window(GtkWindow *parent) {
     gtk_container_set_border_width(GTK_CONTAINER(vbox), 8);
     gtk_container_add(GTK_CONTAINER(window), vbox);
 
-    /* List store and tree */
-    GtkListStore *store = gtk_list_store_new(N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_INT, G_TYPE_INT, G_TYPE_DOUBLE, G_TYPE_DOUBLE, G_TYPE_DOUBLE, G_TYPE_DOUBLE);
-    refresh_tree_store(store);
-
-    GtkWidget *tree = gtk_tree_view_new_with_model(GTK_TREE_MODEL(store));
+    /* Tree over the record cache */
+    GtkWidget *tree = gtk_tree_view_new();
+    refresh_tree_store(GTK_TREE_VIEW(tree));
     GtkCellRenderer *r;
 
     r = gtk_cell_renderer_text_new();
@@ -645,6 +2149,16 @@ static void show_main_window(GtkWindow *parent) {
     GtkTreeViewColumn *c8 = gtk_tree_view_column_new_with_attributes("CGPA Y4", r, "text", COL_CGPA4, NULL);
     gtk_tree_view_append_column(GTK_TREE_VIEW(tree), c8);
 
+    /* fixed sizes let the view lay out only the rows on screen instead of measuring every record */
+    GtkTreeViewColumn *cols[] = { c1, c2, c3, c4, c5, c6, c7, c8 };
+    const int widths[] = { 140, 200, 60, 60, 90, 90, 90, 90 };
+    for (int i = 0; i < 8; i++) {
+        gtk_tree_view_column_set_sizing(cols[i], GTK_TREE_VIEW_COLUMN_FIXED);
+        gtk_tree_view_column_set_fixed_width(cols[i], widths[i]);
+        gtk_tree_view_column_set_resizable(cols[i], TRUE);
+    }
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(tree), TRUE);
+
     GtkWidget *scrolled = gtk_scrolled_window_new(NULL, NULL);
     gtk_container_add(GTK_CONTAINER(scrolled), tree);
     gtk_box_pack_start(GTK_BOX(vbox), scrolled, TRUE, TRUE, 0);
@@ -658,6 +2172,8 @@ static void show_main_window(GtkWindow *parent) {
     GtkWidget *delete_btn = gtk_button_new_with_label("Delete");
     GtkWidget *refresh_btn = gtk_button_new_with_label("Refresh");
     GtkWidget *search_btn = gtk_button_new_with_label("Find / View");
+    GtkWidget *name_search_btn = gtk_button_new_with_label("Find by Name");
+    GtkWidget *trends_btn = gtk_button_new_with_label("Trends");
     GtkWidget *logout_btn = gtk_button_new_with_label("Logout");
 
     gtk_box_pack_start(GTK_BOX(hbox), add_btn, FALSE, FALSE, 0);
@@ -665,29 +2181,43 @@ static void show_main_window(GtkWindow *parent) {
     gtk_box_pack_start(GTK_BOX(hbox), delete_btn, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(hbox), refresh_btn, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(hbox), search_btn, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), name_search_btn, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), trends_btn, FALSE, FALSE, 0);
     gtk_box_pack_end(GTK_BOX(hbox), logout_btn, FALSE, FALSE, 0);
 
-    /* Set permissions based on role */
-    bool can_modify = (strcmp(current_role, "ADMIN") == 0 || strcmp(current_role, "STAFF") == 0);
-    bool is_student = (strcmp(current_role, "USER") == 0);
-    bool is_guest = (strcmp(current_role, "GUEST") == 0);
+    /* cache statistics (the roster cache is only used by full-roster sessions) */
+    if (session_can(CAP_VIEW_ALL)) {
+        GtkWidget *status = gtk_label_new("");
+        gtk_label_set_xalign(GTK_LABEL(status), 0.0);
+        gtk_box_pack_start(GTK_BOX(vbox), status, FALSE, FALSE, 0);
+        student_cache.status_label = status;
+        g_signal_connect(status, "destroy", G_CALLBACK(status_label_destroy_cb), NULL);
+        cache_update_status();
+    }
 
-    gtk_widget_set_sensitive(add_btn, can_modify);
-    gtk_widget_set_sensitive(update_btn, can_modify);
-    gtk_widget_set_sensitive(delete_btn, can_modify);
+    /* Set permissions from the session capabilities */
+    gtk_widget_set_sensitive(add_btn, session_can(CAP_MODIFY));
+    gtk_widget_set_sensitive(update_btn, session_can(CAP_MODIFY));
+    gtk_widget_set_sensitive(delete_btn, session_can(CAP_MODIFY));
+    gtk_widget_set_sensitive(name_search_btn, session_can(CAP_VIEW_ALL));
+    gtk_widget_set_sensitive(trends_btn, session_can(CAP_TRENDS));
     /* Guests and students cannot modify; guests can view; students can only view self via Find / View */
 
     /* AppData */
     AppData *ad = (AppData *)g_malloc(sizeof(AppData));
-    ad->store = store; ad->tree = GTK_TREE_VIEW(tree); ad->parent = GTK_WINDOW(window);
+    ad->tree = GTK_TREE_VIEW(tree); ad->parent = GTK_WINDOW(window);
 
     g_signal_connect(add_btn, "clicked", G_CALLBACK(add_btn_cb), ad);
     g_signal_connect(update_btn, "clicked", G_CALLBACK(update_btn_cb), ad);
     g_signal_connect(delete_btn, "clicked", G_CALLBACK(delete_btn_cb), ad);
-    g_signal_connect(refresh_btn, "clicked", G_CALLBACK(refresh_btn_cb), store);
+    g_signal_connect(refresh_btn, "clicked", G_CALLBACK(refresh_btn_cb), ad);
     g_signal_connect(search_btn, "clicked", G_CALLBACK(search_btn_cb), ad);
+    g_signal_connect(name_search_btn, "clicked", G_CALLBACK(name_search_btn_cb), ad);
+    g_signal_connect(trends_btn, "clicked", G_CALLBACK(trends_btn_cb), ad);
     g_signal_connect(logout_btn, "clicked", G_CALLBACK(logout_btn_cb), window);
     g_signal_connect(tree, "row-activated", G_CALLBACK(row_activated_cb), ad);
+    g_signal_connect(gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(scrolled)), "value-changed",
+                     G_CALLBACK(tree_scrolled_cb), ad);
 
     /* free appdata when window destroyed */
     g_signal_connect(window, "destroy", G_CALLBACK(g_free), ad);
@@ -729,9 +2259,10 @@ static void show_login_dialog(GtkWindow *parent) {
         const char *username = gtk_entry_get_text(GTK_ENTRY(user_entry));
         const char *password = gtk_entry_get_text(GTK_ENTRY(pass_entry));
         char rolebuf[64] = "";
-        if (load_credentials(username, password, rolebuf, sizeof(rolebuf))) {
+        char regbuf[32] = "";
+        if (load_credentials(username, password, rolebuf, sizeof(rolebuf), regbuf, sizeof(regbuf))) {
             strncpy(current_user, username, sizeof(current_user)-1);
-            strncpy(current_role, rolebuf, sizeof(current_role)-1);
+            session_begin(rolebuf, regbuf);
             gtk_widget_destroy(dlg);
             show_main_window(nullptr);
             return;